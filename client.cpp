@@ -8,11 +8,17 @@
 #include <vector>
 #include <zlib.h>
 #include <chrono>
+#include <fcntl.h>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/uio.h>
 
 #define DEFAULT_PORT 12345
 #define DEFAULT_SERVER "127.0.0.1"
 #define CHUNK_SIZE 50000
 #define ACK_BUFFER_SIZE 1024
+#define RECORD_DATA 'D' // Enregistrement contenant un chunk de données
+#define RECORD_ZERO 'Z' // Enregistrement décrivant une plage de zéros (taille en ASCII)
 
 template <typename T>
 T my_min(T a, T b)
@@ -152,10 +158,79 @@ bool compressChunkWithFallback(const std::vector<char> &input, std::vector<char>
     return true;
 }
 
-size_t readFileChunk(std::ifstream &file, char *buffer, size_t chunkSize)
+size_t readFileChunk(int fd, char *buffer, size_t chunkSize, off_t offset)
 {
-    file.read(buffer, chunkSize);
-    return file.gcount();
+    ssize_t readBytes = pread(fd, buffer, chunkSize, offset);
+    return readBytes > 0 ? static_cast<size_t>(readBytes) : 0;
+}
+
+// Vérifie rapidement si un chunk ne contient que des zéros
+bool isZeroChunk(const char *buffer, size_t size)
+{
+    return size > 0 && buffer[0] == 0 && memcmp(buffer, buffer + 1, size - 1) == 0;
+}
+
+// Localise la prochaine zone de données à partir de offset (SEEK_DATA/SEEK_HOLE).
+// Si le système de fichiers ne le supporte pas, le reste du fichier est traité comme des données.
+void findDataRegion(int fd, off_t offset, off_t fileSize, off_t &dataStart, off_t &dataEnd)
+{
+    dataStart = lseek(fd, offset, SEEK_DATA);
+    if (dataStart == -1)
+    {
+        // ENXIO : il ne reste qu'un trou jusqu'à la fin du fichier
+        dataStart = (errno == ENXIO) ? fileSize : offset;
+        dataEnd = fileSize;
+        return;
+    }
+
+    dataEnd = lseek(fd, dataStart, SEEK_HOLE);
+    if (dataEnd == -1 || dataEnd > fileSize)
+    {
+        dataEnd = fileSize;
+    }
+}
+
+// Envoie un enregistrement : un octet de type suivi de la charge utile
+bool sendRecord(int sockfd, char recordType, const char *payload, size_t payloadSize, sockaddr_in &serverAddr)
+{
+    struct iovec iov[2];
+    iov[0].iov_base = &recordType;
+    iov[0].iov_len = 1;
+    iov[1].iov_base = const_cast<char *>(payload);
+    iov[1].iov_len = payloadSize;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &serverAddr;
+    msg.msg_namelen = sizeof(serverAddr);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    return sendmsg(sockfd, &msg, 0) != -1;
+}
+
+bool sendZeroRange(int sockfd, size_t length, sockaddr_in &serverAddr)
+{
+    std::string lengthStr = std::to_string(length);
+    return sendRecord(sockfd, RECORD_ZERO, lengthStr.c_str(), lengthStr.size(), serverAddr);
+}
+
+// Attend l'acquittement du serveur ; retourne false en cas d'erreur de réception
+bool waitForAck(int sockfd, std::string &ack)
+{
+    char ackBuffer[ACK_BUFFER_SIZE];
+    sockaddr_in ackAddr;
+    socklen_t ackLen = sizeof(ackAddr);
+
+    ssize_t ackReceived = recvfrom(sockfd, ackBuffer, ACK_BUFFER_SIZE, 0, (struct sockaddr *)&ackAddr, &ackLen);
+    if (ackReceived == -1)
+    {
+        logError("Error receiving acknowledgment!");
+        return false;
+    }
+
+    ack.assign(ackBuffer, ackReceived);
+    return true;
 }
 
 void closeSocket(int sockfd)
@@ -175,17 +250,15 @@ void sendFile(int sockfd, const char *filePath, bool compressFlag, bool verbose,
         return;
     }
 
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open())
+    int fd = open(filePath, O_RDONLY);
+    if (fd == -1)
     {
         logError("Error opening file!");
         return;
     }
 
     size_t bytesSent = 0;
-    file.seekg(0, std::ios::end);
-    size_t fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
+    size_t fileSize = lseek(fd, 0, SEEK_END);
 
     char buffer[CHUNK_SIZE];
     std::vector<char> compressedChunk;
@@ -201,24 +274,69 @@ void sendFile(int sockfd, const char *filePath, bool compressFlag, bool verbose,
     // Send file metadata
     sendFileMetadata(sockfd, fileName, fileSize, serverAddr);
 
-    // Wait for acknowledgment before starting transfer
-    char ackBuffer[ACK_BUFFER_SIZE];
-    sockaddr_in ackAddr;
-    socklen_t ackLen = sizeof(ackAddr);
+    std::string ack;
 
-    while (bytesSent < fileSize)
+    // Les trous et les chunks nuls sont accumulés puis envoyés en une seule plage de zéros
+    size_t pendingZeroBytes = 0;
+    off_t dataStart = 0;
+    off_t dataEnd = 0;
+    findDataRegion(fd, 0, fileSize, dataStart, dataEnd);
+
+    while (bytesSent + pendingZeroBytes < fileSize)
     {
-        size_t bytesToRead = my_min(static_cast<size_t>(CHUNK_SIZE), fileSize - bytesSent);
-        size_t readBytes = readFileChunk(file, buffer, bytesToRead);
+        off_t offset = bytesSent + pendingZeroBytes;
+        if (offset >= dataEnd)
+        {
+            findDataRegion(fd, offset, fileSize, dataStart, dataEnd);
+        }
+
+        // Trou : rien à lire, on l'ajoute à la plage de zéros en attente
+        if (offset < dataStart)
+        {
+            pendingZeroBytes += dataStart - offset;
+            continue;
+        }
+
+        size_t bytesToRead = my_min(static_cast<size_t>(CHUNK_SIZE), static_cast<size_t>(dataEnd - offset));
+        size_t readBytes = readFileChunk(fd, buffer, bytesToRead, offset);
+        if (readBytes == 0)
+        {
+            logError("Error reading file!");
+            break;
+        }
+
+        if (isZeroChunk(buffer, readBytes))
+        {
+            pendingZeroBytes += readBytes;
+            continue;
+        }
+
+        if (pendingZeroBytes > 0)
+        {
+            if (!sendZeroRange(sockfd, pendingZeroBytes, serverAddr))
+            {
+                logError("Error sending zero range!");
+                close(fd);
+                return;
+            }
+            if (!waitForAck(sockfd, ack))
+            {
+                close(fd);
+                return;
+            }
+            bytesSent += pendingZeroBytes;
+            pendingZeroBytes = 0;
+        }
 
         if (compressFlag)
         {
             if (!compressChunkWithFallback(std::vector<char>(buffer, buffer + readBytes), compressedChunk, fallbackToUncompressed, verbose))
             {
                 // If compression fails, send uncompressed data
-                if (sendto(sockfd, buffer, readBytes, 0, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) == -1)
+                if (!sendRecord(sockfd, RECORD_DATA, buffer, readBytes, serverAddr))
                 {
                     logError("Error sending uncompressed data after compression failed!");
+                    close(fd);
                     return;
                 }
                 fallbackToUncompressed = false;
@@ -226,32 +344,33 @@ void sendFile(int sockfd, const char *filePath, bool compressFlag, bool verbose,
             else
             {
                 // Send compressed data
-                if (sendto(sockfd, compressedChunk.data(), compressedChunk.size(), 0, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) == -1)
+                if (!sendRecord(sockfd, RECORD_DATA, compressedChunk.data(), compressedChunk.size(), serverAddr))
                 {
                     logError("Error sending compressed data!");
+                    close(fd);
                     return;
                 }
             }
         }
         else
         {
-            if (sendto(sockfd, buffer, readBytes, 0, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) == -1)
+            if (!sendRecord(sockfd, RECORD_DATA, buffer, readBytes, serverAddr))
             {
                 logError("Error sending uncompressed data!");
+                close(fd);
                 return;
             }
         }
 
         // Wait for acknowledgment (server response)
-        ssize_t ackReceived = recvfrom(sockfd, ackBuffer, ACK_BUFFER_SIZE, 0, (struct sockaddr *)&ackAddr, &ackLen);
-        if (ackReceived == -1)
+        if (!waitForAck(sockfd, ack))
         {
-            logError("Error receiving acknowledgment!");
+            close(fd);
             return;
         }
 
         // If decompression failed on the server, we need to resend the data
-        if (std::string(ackBuffer, ackReceived) == "Decompression failed. Please re-compress and resend.")
+        if (ack == "Decompression failed. Please re-compress and resend.")
         {
             std::cerr << "\nDecompression failed on server. Retrying...\n";
             bytesSent -= readBytes; // Rewind the sent bytes for retry
@@ -265,13 +384,32 @@ void sendFile(int sockfd, const char *filePath, bool compressFlag, bool verbose,
         showProgress(totalBytesSent, fileSize, elapsedTime);
     }
 
+    // Plage de zéros finale (fin de fichier creuse)
+    if (pendingZeroBytes > 0)
+    {
+        if (!sendZeroRange(sockfd, pendingZeroBytes, serverAddr))
+        {
+            logError("Error sending zero range!");
+            close(fd);
+            return;
+        }
+        if (!waitForAck(sockfd, ack))
+        {
+            close(fd);
+            return;
+        }
+        bytesSent += pendingZeroBytes;
+        auto elapsedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        showProgress(bytesSent, fileSize, elapsedTime);
+    }
+
     std::cout << std::endl;
     if (verbose)
     {
         std::cout << "File sent successfully!\n";
     }
 
-    file.close();
+    close(fd);
 }
 
 int main(int argc, char *argv[])
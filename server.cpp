@@ -17,6 +17,9 @@
 #define DEFAULT_PORT 12345
 #define CHUNK_SIZE 4096
 #define ACK_BUFFER_SIZE 256
+#define RECORD_BUFFER_SIZE 65536 // Taille maximale d'un datagramme UDP
+#define RECORD_DATA 'D'          // Enregistrement contenant un chunk de données
+#define RECORD_ZERO 'Z'          // Enregistrement décrivant une plage de zéros (taille en ASCII)
 
 void showUsage()
 {
@@ -139,9 +142,10 @@ void saveReceivedFile(int serverSocket, sockaddr_in &serverAddr, bool decompress
     size_t totalBytesWritten = 0; // Variable pour suivre la progression
     ssize_t bytesReceived = 0;
     std::vector<char> decompressedChunk;
+    std::vector<char> recordBuffer(RECORD_BUFFER_SIZE);
 
     // Boucle pour recevoir les données
-    while ((bytesReceived = recvfrom(serverSocket, metadataBuffer, sizeof(metadataBuffer), 0,
+    while ((bytesReceived = recvfrom(serverSocket, recordBuffer.data(), recordBuffer.size(), 0,
                                      (struct sockaddr *)&clientAddr, &clientAddrLen)) > 0)
     {
         if (bytesReceived == -1)
@@ -150,10 +154,46 @@ void saveReceivedFile(int serverSocket, sockaddr_in &serverAddr, bool decompress
             break;
         }
 
-        if (decompressFlag)
+        // Le premier octet indique le type d'enregistrement
+        char recordType = recordBuffer[0];
+        const char *payload = recordBuffer.data() + 1;
+        size_t payloadSize = bytesReceived - 1;
+
+        if (recordType == RECORD_ZERO)
+        {
+            size_t zeroBytes = 0;
+            try
+            {
+                zeroBytes = std::stoull(std::string(payload, payloadSize));
+            }
+            catch (const std::exception &e)
+            {
+                logError("Failed to parse zero range length! Error: " + std::string(e.what()));
+                break;
+            }
+
+            // On saute la plage au lieu de l'écrire : le fichier de destination reste creux
+            outFile.seekp(zeroBytes, std::ios::cur);
+            totalBytesWritten += zeroBytes;
+
+            const char *ackMessage = "1";
+            ssize_t ackSent = sendto(serverSocket, ackMessage, strlen(ackMessage), 0,
+                                     (struct sockaddr *)&clientAddr, sizeof(clientAddr));
+            if (ackSent == -1)
+            {
+                logError("Error sending zero range acknowledgment to client.");
+                break;
+            }
+        }
+        else if (recordType != RECORD_DATA)
+        {
+            logError("Unknown record type received, ignoring.");
+            continue;
+        }
+        else if (decompressFlag)
         {
             // Décompression des données reçues
-            bool decompressionSuccess = decompressChunk(std::vector<char>(metadataBuffer, metadataBuffer + bytesReceived), decompressedChunk, verbose);
+            bool decompressionSuccess = decompressChunk(std::vector<char>(payload, payload + payloadSize), decompressedChunk, verbose);
 
             if (!decompressionSuccess)
             {
@@ -192,8 +232,8 @@ void saveReceivedFile(int serverSocket, sockaddr_in &serverAddr, bool decompress
         else
         {
             // Écriture des données directement dans le fichier
-            outFile.write(metadataBuffer, bytesReceived);
-            totalBytesWritten += bytesReceived;
+            outFile.write(payload, payloadSize);
+            totalBytesWritten += payloadSize;
 
             // Send error message back to client asking for re-compression or resending the chunk
             const char *ackMessage = "1";
@@ -232,6 +272,12 @@ void saveReceivedFile(int serverSocket, sockaddr_in &serverAddr, bool decompress
     }
 
     outFile.close(); // Fermeture explicite du fichier
+
+    // Une plage de zéros en fin de fichier n'est qu'un déplacement : on fixe la taille finale
+    if (truncate(fileName.c_str(), totalBytesWritten) == -1)
+    {
+        logError("Failed to set output file size! Error: " + std::string(strerror(errno)));
+    }
 }
 
 // Function to create and bind the server socket